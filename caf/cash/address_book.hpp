@@ -0,0 +1,70 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_ADDRESS_BOOK_HPP
+#define CAF_CASH_ADDRESS_BOOK_HPP
+
+#include <memory>
+#include <chrono>
+
+#include "caf/actor.hpp"
+
+#include "caf/cash/address_index.hpp"
+
+namespace caf {
+namespace cash {
+
+/// Holds the address index of all nodes. Readers always see a consistent
+/// snapshot and never block, because the refresher replaces whole
+/// snapshots instead of mutating them.
+class address_book {
+ public:
+  using snapshot = std::shared_ptr<const address_index>;
+
+  /// Interface addresses of all known nodes or `nullptr`
+  /// if the refresher did not publish an index yet.
+  inline snapshot addresses() const {
+    return std::atomic_load(&m_addresses);
+  }
+
+  inline void set_addresses(snapshot ptr) {
+    std::atomic_store(&m_addresses, std::move(ptr));
+  }
+
+ private:
+  snapshot m_addresses;
+};
+
+/// Default interval between two refreshes of the address book.
+constexpr std::chrono::milliseconds address_book_interval{2000};
+
+/// Maximum number of known nodes whose info is re-fetched per refresh.
+constexpr size_t address_book_refresh_batch = 32;
+
+/// Spawns an actor that refreshes `book` in the background using
+/// `nexus_proxy`. Nodes that appeared since the last refresh cause a
+/// `NodeInfo` request, while known nodes are re-fetched round-robin in
+/// batches of `address_book_refresh_batch` to pick up changed interfaces.
+actor spawn_address_book(actor nexus_proxy,
+                         std::shared_ptr<address_book> book);
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_ADDRESS_BOOK_HPP
@@ -0,0 +1,98 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_ADDRESS_INDEX_HPP
+#define CAF_CASH_ADDRESS_INDEX_HPP
+
+#include <array>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+#include "caf/node_id.hpp"
+#include "caf/io/network/protocol.hpp"
+
+namespace caf {
+namespace cash {
+
+/// A parsed IP or MAC address, optionally shortened to a prefix.
+struct address_key {
+  io::network::protocol family;
+  std::array<uint8_t, 16> bytes;
+  // number of significant bits
+  size_t bits;
+};
+
+/// Parses IPv4, IPv6 and MAC addresses with an optional `/<prefix-length>`.
+/// MAC addresses may also be given as a prefix of their bytes, e.g.,
+/// `00:1b:21` matches all addresses of that vendor.
+bool parse_address(const std::string& str, address_key& result);
+
+/// Inverted index from interface addresses to the nodes owning them.
+/// Addresses are kept as fixed-width keys in one sorted vector per family,
+/// hence an exact address, a CIDR range or a MAC prefix is a single range
+/// of that vector. Instances are immutable once built and shared between
+/// threads.
+class address_index {
+ public:
+  struct entry {
+    node_id node;
+    std::string hostname;
+    std::string interface;
+    std::string address;
+  };
+
+  /// Adds `addr` of interface `iface` on `node` to the index.
+  /// Returns `false` if `addr` is not a valid address. Call `seal`
+  /// after adding the last address.
+  bool add(io::network::protocol family, const std::string& addr,
+           const node_id& node, const std::string& hostname,
+           const std::string& iface);
+
+  /// Sorts all keys, must be called before the first `find`.
+  void seal();
+
+  /// Appends all entries matching `key` to `out`. An address without
+  /// prefix length matches exactly, otherwise all addresses in the
+  /// given range match.
+  void find(const address_key& key, std::vector<const entry*>& out) const;
+
+  inline size_t size() const {
+    return m_entries.size();
+  }
+
+ private:
+  // address bytes padded with zeros and the position in `m_entries`
+  using key_type = std::pair<std::array<uint8_t, 16>, uint32_t>;
+
+  std::vector<key_type>& keys(io::network::protocol family);
+
+  const std::vector<key_type>& keys(io::network::protocol family) const;
+
+  std::vector<entry> m_entries;
+  std::vector<key_type> m_ethernet;
+  std::vector<key_type> m_ipv4;
+  std::vector<key_type> m_ipv6;
+};
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_ADDRESS_INDEX_HPP
@@ -0,0 +1,131 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_CAPTURE_SINK_HPP
+#define CAF_CASH_CAPTURE_SINK_HPP
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+
+#include "caf/message.hpp"
+#include "caf/scoped_actor.hpp"
+#include "caf/actor_namespace.hpp"
+
+namespace caf {
+namespace cash {
+
+/// Continuously drains the mailbox of a scoped actor on its own thread,
+/// keeping per-type counters and a rate-limited sample of the stream.
+class capture_sink : private actor_namespace::backend {
+ public:
+  using clock_type = std::chrono::steady_clock;
+
+  struct type_stats {
+    uint64_t count = 0;
+    uint64_t bytes = 0;
+    // messages that could not be serialized, i.e., have no size
+    uint64_t unsized = 0;
+    // messages per second during the last completed window
+    double last_rate = 0;
+    // messages received in the current window
+    uint64_t window = 0;
+  };
+
+  /// Maximum number of samples kept until they are displayed.
+  static constexpr size_t max_samples = 1000;
+
+  /// Interval for updating rates and checking whether we got stopped.
+  static constexpr std::chrono::milliseconds tick_interval{100};
+
+  /// Starts draining `src`, converting at most `samples_per_sec` messages
+  /// per second to strings. If `spill_file` is not empty, every message is
+  /// appended to it in CAF's binary format, prefixed by its 32-bit size.
+  capture_sink(scoped_actor& src, size_t samples_per_sec,
+               const std::string& spill_file);
+
+  ~capture_sink();
+
+  capture_sink(const capture_sink&) = delete;
+  capture_sink& operator=(const capture_sink&) = delete;
+
+  /// Returns whether the spill file, if any, was opened successfully.
+  inline bool good() const {
+    return m_good;
+  }
+
+  /// Returns a copy of the counters, indexed by message type.
+  std::map<std::string, type_stats> stats() const;
+
+  /// Returns the total number of captured messages and seconds elapsed.
+  std::pair<uint64_t, double> totals() const;
+
+  /// Moves all samples collected so far to the caller.
+  std::vector<std::string> take_samples();
+
+  /// Stops the capture thread.
+  void stop();
+
+ private:
+  void run();
+
+  void add(const message& msg);
+
+  // closes the current rate window if it lasted at least one second,
+  // requires m_mtx to be locked
+  void roll_window(clock_type::time_point now);
+
+  static std::string type_key(const message& msg);
+
+  // our namespace is only used for writing actor handles,
+  // hence it never needs to create a proxy
+  actor_proxy_ptr make_proxy(const node_id&, actor_id) override;
+
+  scoped_actor& m_src;
+  actor_namespace m_ns;
+  // identifies our ticks, since ticks of a previous
+  // capture may still be in the mailbox of `m_src`
+  uint64_t m_tick_id;
+  size_t m_samples_per_sec;
+  std::string m_spill_path;
+  std::ofstream m_spill;
+  bool m_good;
+  std::atomic<bool> m_running;
+  clock_type::time_point m_start;
+  clock_type::time_point m_window_start;
+  size_t m_sampled_in_window;
+  uint64_t m_total;
+  std::vector<char> m_buf;
+  std::map<std::string, type_stats> m_stats;
+  std::deque<std::string> m_samples;
+  mutable std::mutex m_mtx;
+  std::thread m_thread;
+};
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_CAPTURE_SINK_HPP
@@ -0,0 +1,78 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_COMPLETION_INDEX_HPP
+#define CAF_CASH_COMPLETION_INDEX_HPP
+
+#include <memory>
+#include <chrono>
+
+#include "caf/actor.hpp"
+#include "caf/node_id.hpp"
+
+#include "caf/cash/prefix_index.hpp"
+
+namespace caf {
+namespace cash {
+
+/// Holds the completion candidates for node and actor arguments.
+/// Readers always see a consistent snapshot and never block, because
+/// the indexer replaces whole snapshots instead of mutating them.
+class completion_index {
+ public:
+  using snapshot = std::shared_ptr<const prefix_index>;
+
+  completion_index();
+
+  /// Hostnames, `hostname:pid` forms and node IDs of all known nodes.
+  inline snapshot nodes() const {
+    return std::atomic_load(&m_nodes);
+  }
+
+  /// IDs of all actors known on the current node.
+  inline snapshot actors() const {
+    return std::atomic_load(&m_actors);
+  }
+
+  inline void set_nodes(snapshot ptr) {
+    std::atomic_store(&m_nodes, std::move(ptr));
+  }
+
+  inline void set_actors(snapshot ptr) {
+    std::atomic_store(&m_actors, std::move(ptr));
+  }
+
+ private:
+  snapshot m_nodes;
+  snapshot m_actors;
+};
+
+/// Default interval between two refreshes of the completion index.
+constexpr std::chrono::milliseconds indexer_interval{2000};
+
+/// Spawns an actor that incrementally refreshes `idx` in the background
+/// using `nexus_proxy`. Only nodes that appeared since the last refresh
+/// cause a `NodeInfo` request. Send `{SetNode, node_id}` to select the
+/// node whose actor IDs are indexed.
+actor spawn_indexer(actor nexus_proxy, std::shared_ptr<completion_index> idx);
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_COMPLETION_INDEX_HPP
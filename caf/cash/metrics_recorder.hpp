@@ -0,0 +1,48 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_METRICS_RECORDER_HPP
+#define CAF_CASH_METRICS_RECORDER_HPP
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include "caf/actor.hpp"
+#include "caf/node_id.hpp"
+
+#include "caf/cash/metrics_store.hpp"
+
+namespace caf {
+namespace cash {
+
+/// Returns the name of the series storing the metrics of `node`.
+std::string series_name(const node_id& node);
+
+/// Spawns an actor that appends CPU load (`cpu`), RAM in use (`ram`) and
+/// the number of actors (`actors`) of every node known to `nexus_proxy`
+/// to `store` every `interval`.
+actor spawn_metrics_recorder(actor nexus_proxy,
+                             std::shared_ptr<metrics_store> store,
+                             std::chrono::milliseconds interval);
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_METRICS_RECORDER_HPP
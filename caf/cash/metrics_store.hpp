@@ -0,0 +1,162 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_METRICS_STORE_HPP
+#define CAF_CASH_METRICS_STORE_HPP
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <utility>
+
+namespace caf {
+namespace cash {
+
+/// Append-only on-disk store for numeric time series. Each series (one per
+/// node) is a directory with two files per metric: `<metric>.dat` holds
+/// compressed blocks and `<metric>.idx` holds one fixed-size entry per
+/// block with its time range, min, max, sum and file offset.
+///
+/// Blocks encode timestamps as delta-of-delta and values as the XOR with
+/// their predecessor, using variable-length bit codes. Samples taken at a
+/// regular interval with slowly changing values need a few bits each.
+///
+/// Samples of blocks that are not yet full are also appended to a log file
+/// in the root directory, which is replayed when opening the store.
+class metrics_store {
+ public:
+  /// Timestamps are milliseconds since epoch.
+  using timestamp = int64_t;
+
+  /// Number of samples per block.
+  static constexpr uint32_t block_size = 1024;
+
+  /// Maximum number of buckets returned by a single query.
+  static constexpr size_t max_buckets = 100000;
+
+  /// Size of the log in bytes that causes all open blocks to be written.
+  static constexpr size_t max_wal_size = 64 * 1024 * 1024;
+
+  struct block_info {
+    timestamp t_min;
+    timestamp t_max;
+    double v_min;
+    double v_max;
+    double v_sum;
+    uint32_t count;
+    uint32_t size;
+    uint64_t offset;
+  };
+
+  /// Aggregate of all samples in `[start, start + step)`.
+  struct bucket {
+    timestamp start;
+    double min;
+    double max;
+    double sum;
+    uint64_t count;
+  };
+
+  /// Opens or creates a store at directory `root`. A store opened with
+  /// `read_only` neither creates nor modifies any file, ignores `append`,
+  /// `set_label` and `flush`, and only reads samples of open blocks from
+  /// the log.
+  explicit metrics_store(std::string root, bool read_only = false);
+
+  ~metrics_store();
+
+  metrics_store(const metrics_store&) = delete;
+  metrics_store& operator=(const metrics_store&) = delete;
+
+  /// Returns whether the root directory exists or was created.
+  inline bool good() const {
+    return m_good;
+  }
+
+  inline const std::string& root() const {
+    return m_root;
+  }
+
+  /// Sets a human-readable label for `series`, e.g., `hostname:pid`.
+  void set_label(const std::string& series, const std::string& label);
+
+  /// Appends a sample. Timestamps of a metric must not decrease.
+  void append(const std::string& series, const std::string& metric,
+              timestamp ts, double value);
+
+  /// Writes all partially filled blocks to disk and clears the log.
+  void flush();
+
+  /// Returns all series with their labels.
+  std::vector<std::pair<std::string, std::string>> series() const;
+
+  /// Aggregates all samples of `metric` in `[from, to)` into buckets
+  /// of `step` milliseconds. Empty buckets are omitted. The step is
+  /// widened if the range would need more than `max_buckets` buckets.
+  std::vector<bucket> query(const std::string& series,
+                            const std::string& metric, timestamp from,
+                            timestamp to, timestamp step) const;
+
+ private:
+  struct open_block {
+    std::vector<timestamp> times;
+    std::vector<double> values;
+  };
+
+  using key_type = std::pair<std::string, std::string>;
+
+  std::string path(const std::string& series, const std::string& metric,
+                   const char* suffix) const;
+
+  void seal(const key_type& key, open_block& blk);
+
+  // reads the log into the open blocks
+  void replay();
+
+  // appends a sample to the log, requires m_mtx to be locked
+  void log(const key_type& key, timestamp ts, double value);
+
+  // seals all open blocks and truncates the log, requires m_mtx to be locked
+  void checkpoint();
+
+  std::string m_root;
+  bool m_good;
+  bool m_read_only;
+  std::map<key_type, open_block> m_open;
+  std::map<std::string, std::string> m_labels;
+  std::ofstream m_wal;
+  std::map<key_type, uint32_t> m_wal_keys;
+  mutable std::mutex m_mtx;
+};
+
+/// Parses a point in time relative to `now`: `now`, `-<n><unit>`,
+/// `<seconds since epoch>` or `YYYY-MM-DD[THH:MM[:SS]]` (UTC).
+bool parse_time(const std::string& str, metrics_store::timestamp now,
+                metrics_store::timestamp& result);
+
+/// Parses a duration `<n><unit>` with unit `ms`, `s`, `m`, `h`, `d` or `w`.
+bool parse_duration(const std::string& str, metrics_store::timestamp& result);
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_METRICS_STORE_HPP
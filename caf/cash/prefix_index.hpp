@@ -0,0 +1,83 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_PREFIX_INDEX_HPP
+#define CAF_CASH_PREFIX_INDEX_HPP
+
+#include <string>
+#include <vector>
+#include <cstddef>
+#include <utility>
+#include <algorithm>
+
+namespace caf {
+namespace cash {
+
+/// An immutable, sorted set of strings supporting prefix range lookups
+/// in `O(log n)` without any allocation per lookup.
+class prefix_index {
+ public:
+  using const_iterator = std::vector<std::string>::const_iterator;
+  using range = std::pair<const_iterator, const_iterator>;
+
+  prefix_index() = default;
+
+  explicit prefix_index(std::vector<std::string> entries)
+      : m_entries(std::move(entries)) {
+    std::sort(m_entries.begin(), m_entries.end());
+    m_entries.erase(std::unique(m_entries.begin(), m_entries.end()),
+                    m_entries.end());
+  }
+
+  /// Returns the range of all entries starting with `prefix`.
+  range equal_prefix(const std::string& prefix) const {
+    auto first = std::lower_bound(m_entries.begin(), m_entries.end(), prefix);
+    auto last = std::upper_bound(first, m_entries.end(), prefix,
+      [](const std::string& pre, const std::string& entry) {
+        return entry.compare(0, pre.size(), pre) > 0;
+      }
+    );
+    return {first, last};
+  }
+
+  /// Appends at most `max_results` entries starting with `prefix` to `out`.
+  void complete(const std::string& prefix, std::vector<std::string>& out,
+                size_t max_results) const {
+    auto rng = equal_prefix(prefix);
+    auto n = std::min(static_cast<size_t>(std::distance(rng.first, rng.second)),
+                      max_results);
+    out.insert(out.end(), rng.first, rng.first + static_cast<ptrdiff_t>(n));
+  }
+
+  inline size_t size() const {
+    return m_entries.size();
+  }
+
+  inline bool empty() const {
+    return m_entries.empty();
+  }
+
+ private:
+  std::vector<std::string> m_entries;
+};
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_PREFIX_INDEX_HPP
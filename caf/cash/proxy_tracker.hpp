@@ -0,0 +1,92 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#ifndef CAF_CASH_PROXY_TRACKER_HPP
+#define CAF_CASH_PROXY_TRACKER_HPP
+
+#include <map>
+#include <deque>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <vector>
+#include <cstdint>
+
+#include "caf/actor.hpp"
+#include "caf/node_id.hpp"
+
+namespace caf {
+namespace cash {
+
+/// Keeps a history of BASP proxy counts per node to spot proxy leaks.
+/// Samples are taken on the middleman thread and only read the proxy count
+/// of each node, i.e., no proxy or ID lists are copied while sampling.
+/// Consequently, churn is not tracked: proxies that leak while others
+/// vanish at the same rate keep the count flat and go unnoticed.
+class proxy_tracker {
+ public:
+  using clock_type = std::chrono::steady_clock;
+
+  struct sample {
+    clock_type::time_point time;
+    size_t count;
+  };
+
+  struct trend {
+    node_id node;
+    size_t count;
+    // proxy count difference between oldest and newest sample
+    long growth;
+    // least-squares slope in proxies per minute
+    double slope;
+    // number of intervals with a growing and a shrinking count
+    size_t rising;
+    size_t falling;
+    size_t samples;
+    // true if the count grew in most intervals of the window
+    bool steady;
+  };
+
+  /// Maximum number of samples kept per node.
+  static constexpr size_t max_history = 120;
+
+  /// Minimum number of samples before reporting a steady growth.
+  static constexpr size_t min_samples = 5;
+
+  /// Samples the proxy counts of `nodes`. Must run on the middleman thread.
+  void sample_all(const std::vector<node_id>& nodes);
+
+  /// Computes the trend of each node over the recorded window.
+  std::vector<trend> trends() const;
+
+ private:
+  mutable std::mutex m_mtx;
+  std::map<node_id, std::deque<sample>> m_history;
+};
+
+/// Spawns an actor that samples all nodes known to `nexus_proxy`
+/// every `interval` into `tracker`.
+actor spawn_proxy_tracker(actor nexus_proxy,
+                          std::shared_ptr<proxy_tracker> tracker,
+                          std::chrono::milliseconds interval);
+
+} // namespace cash
+} // namespace caf
+
+#endif // CAF_CASH_PROXY_TRACKER_HPP
@@ -21,6 +21,8 @@
 #define CAF_SHELL_SHELL_HPP
 
 #include <string>
+#include <vector>
+#include <memory>
 
 #include "caf/optional.hpp"
 #include "caf/scoped_actor.hpp"
@@ -31,6 +33,13 @@
 #include "sash/libedit_backend.hpp"
 #include "sash/variables_engine.hpp"
 
+#include "caf/cash/prefix_index.hpp"
+#include "caf/cash/address_book.hpp"
+#include "caf/cash/capture_sink.hpp"
+#include "caf/cash/metrics_store.hpp"
+#include "caf/cash/proxy_tracker.hpp"
+#include "caf/cash/completion_index.hpp"
+
 namespace caf {
 namespace cash {
 
@@ -43,6 +52,10 @@ class shell {
 
   void run(riac::nexus_type nexus);
 
+  /// Appends all completion candidates for `line` to `out`. Never blocks,
+  /// since all candidates are served from in-memory prefix indexes.
+  void complete(const std::string& line, std::vector<std::string>& out);
+
  private:
 
   // global commands
@@ -73,6 +86,20 @@ class shell {
 
   void all_routes(char_iter first, char_iter last);
 
+  void capture(char_iter first, char_iter last);
+
+  void find_addr(char_iter first, char_iter last);
+
+  void proxy_growth(char_iter first, char_iter last);
+
+  void record(char_iter first, char_iter last);
+
+  void query(char_iter first, char_iter last);
+
+  void profile_msg(char_iter first, char_iter last);
+
+  void traceroute(char_iter first, char_iter last);
+
   // Node commands
 
   void whereami(char_iter first, char_iter last);
@@ -103,6 +130,12 @@ class shell {
 
   optional<std::string> to_hostname(const node_id& ni);
 
+  void print_profile(const message& msg);
+
+  std::vector<node_id> route_to(const node_id& src, const node_id& dest);
+
+  actor bounce_target(const node_id& node);
+
   inline std::function<sash::command_result (std::string&, char_iter, char_iter)>
   cb(void (shell::*memfun)(char_iter, char_iter)) {
     return [=](std::string& err, char_iter first, char_iter last) -> sash::command_result {
@@ -124,6 +157,15 @@ class shell {
     send_invidually(std::forward<Ts>(args)...);
   }
 
+  inline bool assert_not_capturing(const char* cmd) {
+    if (m_capture) {
+      set_error(std::string{cmd} + ": mailbox is drained by capture, "
+                                   "run 'capture stop' first");
+      return false;
+    }
+    return true;
+  }
+
   inline bool assert_empty(char_iter first, char_iter last) {
     if (first != last) {
       set_error("to many arguments (none expected)");
@@ -139,11 +181,25 @@ class shell {
 
   bool m_done;
   node_id m_node;
+  // one entry per "node" mode on the CLI's mode stack
+  std::vector<node_id> m_node_stack;
+  node_id m_nexus_node;
   cli_type m_cli;
   scoped_actor m_self;
   scoped_actor m_user;
   actor m_nexus_proxy;
   std::shared_ptr<sash::variables_engine<>> m_engine;
+  std::shared_ptr<completion_index> m_completion;
+  actor m_indexer;
+  std::shared_ptr<address_book> m_address_book;
+  actor m_address_refresher;
+  std::unique_ptr<capture_sink> m_capture;
+  std::shared_ptr<proxy_tracker> m_proxy_tracker;
+  actor m_proxy_sampler;
+  std::shared_ptr<metrics_store> m_store;
+  actor m_recorder;
+  prefix_index m_global_cmds;
+  prefix_index m_node_cmds;
 };
 
 } // namespace cash
@@ -0,0 +1,145 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/address_book.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include "caf/all.hpp"
+#include "caf/riac/all.hpp"
+
+namespace caf {
+namespace cash {
+
+namespace {
+
+struct address_book_state {
+  // last known info of each node
+  std::map<node_id, riac::node_info> infos;
+  // nodes with an outstanding `NodeInfo` request
+  std::set<node_id> requested;
+  // last node re-fetched by the round-robin refresh
+  node_id cursor;
+  bool dirty = true;
+};
+
+void publish(address_book_state& st, address_book& book) {
+  if (!st.dirty || !st.requested.empty()) {
+    return;
+  }
+  auto addrs = std::make_shared<address_index>();
+  for (auto& kvp : st.infos) {
+    auto& ni = kvp.second;
+    for (auto& iface : ni.interfaces) {
+      for (auto& addresses : iface.second) {
+        for (auto& addr : addresses.second) {
+          addrs->add(addresses.first, addr, kvp.first, ni.hostname,
+                     iface.first);
+        }
+      }
+    }
+  }
+  addrs->seal();
+  book.set_addresses(std::move(addrs));
+  st.dirty = false;
+}
+
+void request_info(event_based_actor* self, const actor& nexus_proxy,
+                  std::shared_ptr<address_book_state> st,
+                  std::shared_ptr<address_book> book, const node_id& node) {
+  if (!st->requested.insert(node).second) {
+    return;
+  }
+  self->sync_send(nexus_proxy, atom("NodeInfo"), node).then(
+    [=](const riac::node_info& ni) {
+      st->requested.erase(node);
+      auto i = st->infos.find(node);
+      if (i == st->infos.end()) {
+        st->infos.emplace(node, ni);
+        st->dirty = true;
+      } else if (i->second.hostname != ni.hostname
+                 || i->second.interfaces != ni.interfaces) {
+        i->second = ni;
+        st->dirty = true;
+      }
+      publish(*st, *book);
+    },
+    on(atom("NoNodeInfo")) >> [=] {
+      st->requested.erase(node);
+      publish(*st, *book);
+    }
+  );
+}
+
+behavior refresher(event_based_actor* self, actor nexus_proxy,
+                   std::shared_ptr<address_book> book) {
+  auto st = std::make_shared<address_book_state>();
+  self->send(self, atom("Tick"));
+  return {
+    on(atom("Tick")) >> [=] {
+      self->sync_send(nexus_proxy, atom("Nodes")).then(
+        [=](const std::vector<node_id>& nodes) {
+          std::set<node_id> alive(nodes.begin(), nodes.end());
+          for (auto i = st->infos.begin(); i != st->infos.end();) {
+            if (alive.count(i->first) == 0) {
+              i = st->infos.erase(i);
+              st->dirty = true;
+            } else {
+              ++i;
+            }
+          }
+          // re-fetch a batch of known nodes to pick up changed interfaces
+          if (!st->infos.empty()) {
+            auto i = st->infos.upper_bound(st->cursor);
+            auto n = std::min(address_book_refresh_batch, st->infos.size());
+            for (size_t j = 0; j < n; ++j, ++i) {
+              if (i == st->infos.end()) {
+                i = st->infos.begin();
+              }
+              st->cursor = i->first;
+              request_info(self, nexus_proxy, st, book, i->first);
+            }
+          }
+          // nodes we did not see before
+          for (auto& node : nodes) {
+            if (st->infos.count(node) == 0) {
+              request_info(self, nexus_proxy, st, book, node);
+            }
+          }
+          publish(*st, *book);
+        }
+      );
+      self->delayed_send(self, address_book_interval, atom("Tick"));
+    }
+  };
+}
+
+} // namespace <anonymous>
+
+actor spawn_address_book(actor nexus_proxy,
+                         std::shared_ptr<address_book> book) {
+  return spawn(refresher, std::move(nexus_proxy), std::move(book));
+}
+
+} // namespace cash
+} // namespace caf
@@ -0,0 +1,183 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/address_index.hpp"
+
+#include <limits>
+#include <cctype>
+#include <cstdlib>
+#include <algorithm>
+
+#include <arpa/inet.h>
+
+using caf::io::network::protocol;
+
+namespace caf {
+namespace cash {
+
+namespace {
+
+size_t max_bits(protocol family) {
+  switch (family) {
+    case protocol::ethernet:
+      return 48;
+    case protocol::ipv4:
+      return 32;
+    case protocol::ipv6:
+      return 128;
+  }
+  return 0;
+}
+
+// parses up to six hex bytes separated by ':' or '-'
+bool parse_mac(const std::string& str, address_key& result) {
+  size_t num_bytes = 0;
+  size_t digits = 0;
+  unsigned value = 0;
+  for (auto c : str) {
+    if (c == ':' || c == '-') {
+      if (digits == 0 || num_bytes == 6) {
+        return false;
+      }
+      result.bytes[num_bytes++] = static_cast<uint8_t>(value);
+      digits = 0;
+      value = 0;
+    } else if (isxdigit(static_cast<unsigned char>(c)) && digits < 2) {
+      value = value * 16 + static_cast<unsigned>(
+                             isdigit(static_cast<unsigned char>(c))
+                             ? c - '0'
+                             : tolower(static_cast<unsigned char>(c)) - 'a'
+                               + 10);
+      ++digits;
+    } else {
+      return false;
+    }
+  }
+  if (digits == 0 || num_bytes == 6) {
+    return false;
+  }
+  result.bytes[num_bytes++] = static_cast<uint8_t>(value);
+  result.family = protocol::ethernet;
+  result.bits = num_bytes * 8;
+  return true;
+}
+
+} // namespace <anonymous>
+
+bool parse_address(const std::string& input, address_key& result) {
+  result.bytes.fill(0);
+  auto str = input;
+  // drop IPv6 scope IDs such as "fe80::1%en0"
+  auto scope = str.find('%');
+  std::string prefix_len;
+  auto slash = str.find('/');
+  if (slash != std::string::npos) {
+    prefix_len = str.substr(slash + 1);
+    str.erase(slash);
+  }
+  if (scope != std::string::npos && scope < str.size()) {
+    str.erase(scope);
+  }
+  if (str.empty()) {
+    return false;
+  }
+  if (str.find('.') != std::string::npos) {
+    if (inet_pton(AF_INET, str.c_str(), result.bytes.data()) != 1) {
+      return false;
+    }
+    result.family = protocol::ipv4;
+    result.bits = 32;
+  } else if (str.find("::") == std::string::npos && parse_mac(str, result)) {
+    // nop
+  } else {
+    if (inet_pton(AF_INET6, str.c_str(), result.bytes.data()) != 1) {
+      return false;
+    }
+    result.family = protocol::ipv6;
+    result.bits = 128;
+  }
+  if (!prefix_len.empty()) {
+    char* end;
+    auto n = strtoul(prefix_len.c_str(), &end, 10);
+    if (*end != '\0' || n > result.bits) {
+      return false;
+    }
+    result.bits = n;
+  }
+  return true;
+}
+
+bool address_index::add(protocol family, const std::string& addr,
+                        const node_id& node, const std::string& hostname,
+                        const std::string& iface) {
+  address_key key;
+  if (!parse_address(addr, key) || key.family != family
+      || key.bits < max_bits(family)) {
+    // the index only contains full addresses
+    return false;
+  }
+  keys(family).emplace_back(key.bytes,
+                            static_cast<uint32_t>(m_entries.size()));
+  m_entries.push_back(entry{node, hostname, iface, addr});
+  return true;
+}
+
+void address_index::seal() {
+  for (auto xs : {&m_ethernet, &m_ipv4, &m_ipv6}) {
+    std::sort(xs->begin(), xs->end());
+  }
+}
+
+void address_index::find(const address_key& key,
+                         std::vector<const entry*>& out) const {
+  // all keys starting with the prefix lie in [first, last]
+  auto first = key.bytes;
+  auto last = key.bytes;
+  for (size_t i = key.bits; i < first.size() * 8; ++i) {
+    uint8_t mask = static_cast<uint8_t>(0x80 >> (i % 8));
+    first[i / 8] &= static_cast<uint8_t>(~mask);
+    last[i / 8] |= mask;
+  }
+  auto& xs = keys(key.family);
+  auto max_pos = std::numeric_limits<uint32_t>::max();
+  auto i = std::lower_bound(xs.begin(), xs.end(), key_type{first, 0});
+  auto e = std::upper_bound(i, xs.end(), key_type{last, max_pos});
+  for (; i != e; ++i) {
+    out.push_back(&m_entries[i->second]);
+  }
+}
+
+std::vector<address_index::key_type>& address_index::keys(protocol family) {
+  switch (family) {
+    case protocol::ethernet:
+      return m_ethernet;
+    case protocol::ipv4:
+      return m_ipv4;
+    default:
+      return m_ipv6;
+  }
+}
+
+const std::vector<address_index::key_type>&
+address_index::keys(protocol family) const {
+  return const_cast<address_index*>(this)->keys(family);
+}
+
+} // namespace cash
+} // namespace caf
@@ -0,0 +1,194 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/capture_sink.hpp"
+
+#include <iterator>
+#include <exception>
+
+#include "caf/all.hpp"
+#include "caf/binary_serializer.hpp"
+
+namespace caf {
+namespace cash {
+
+constexpr size_t capture_sink::max_samples;
+constexpr std::chrono::milliseconds capture_sink::tick_interval;
+
+namespace {
+
+std::atomic<uint64_t> s_tick_ids{0};
+
+} // namespace <anonymous>
+
+capture_sink::capture_sink(scoped_actor& src, size_t samples_per_sec,
+                           const std::string& spill_file)
+    : m_src(src),
+      m_ns(*this),
+      m_tick_id(++s_tick_ids),
+      m_samples_per_sec(samples_per_sec),
+      m_spill_path(spill_file),
+      m_good(true),
+      m_running(true),
+      m_start(clock_type::now()),
+      m_window_start(m_start),
+      m_sampled_in_window(0),
+      m_total(0) {
+  if (!m_spill_path.empty()) {
+    m_spill.open(m_spill_path, std::ios::binary | std::ios::app);
+    m_good = m_spill.is_open();
+  }
+  m_thread = std::thread([=] { run(); });
+}
+
+capture_sink::~capture_sink() {
+  stop();
+}
+
+void capture_sink::stop() {
+  m_running = false;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+  if (m_spill.is_open()) {
+    m_spill.close();
+  }
+}
+
+std::map<std::string, capture_sink::type_stats> capture_sink::stats() const {
+  std::lock_guard<std::mutex> guard{m_mtx};
+  return m_stats;
+}
+
+std::pair<uint64_t, double> capture_sink::totals() const {
+  std::lock_guard<std::mutex> guard{m_mtx};
+  std::chrono::duration<double> elapsed = clock_type::now() - m_start;
+  return {m_total, elapsed.count()};
+}
+
+std::vector<std::string> capture_sink::take_samples() {
+  std::lock_guard<std::mutex> guard{m_mtx};
+  std::vector<std::string> result{std::make_move_iterator(m_samples.begin()),
+                                  std::make_move_iterator(m_samples.end())};
+  m_samples.clear();
+  return result;
+}
+
+void capture_sink::run() {
+  // a single periodic tick wakes us up regularly, a timeout per receive
+  // would add a timer and a stale timeout message per captured message
+  actor self = m_src;
+  m_src->send(self, atom("CaptTick"), m_tick_id);
+  while (m_running) {
+    m_src->receive(
+      on(atom("CaptTick"), arg_match) >> [&](uint64_t id) {
+        if (id != m_tick_id) {
+          // left over from a previous capture
+          return;
+        }
+        {
+          // keep rates current while no message arrives
+          std::lock_guard<std::mutex> guard{m_mtx};
+          roll_window(clock_type::now());
+        }
+        if (m_running) {
+          m_src->delayed_send(self, tick_interval, atom("CaptTick"), id);
+        }
+      },
+      others() >> [&] {
+        add(m_src->current_message());
+      }
+    );
+  }
+}
+
+actor_proxy_ptr capture_sink::make_proxy(const node_id&, actor_id) {
+  return nullptr;
+}
+
+void capture_sink::roll_window(clock_type::time_point now) {
+  std::chrono::duration<double> elapsed = now - m_window_start;
+  if (elapsed < std::chrono::seconds(1)) {
+    return;
+  }
+  for (auto& kvp : m_stats) {
+    kvp.second.last_rate = kvp.second.window / elapsed.count();
+    kvp.second.window = 0;
+  }
+  m_window_start = now;
+  m_sampled_in_window = 0;
+}
+
+void capture_sink::add(const message& msg) {
+  m_buf.clear();
+  bool sized = true;
+  try {
+    binary_serializer bs(std::back_inserter(m_buf), &m_ns);
+    bs << msg;
+  } catch (std::exception&) {
+    // e.g. an element without serialization support
+    sized = false;
+  }
+  if (sized && m_spill.is_open()) {
+    auto size = static_cast<uint32_t>(m_buf.size());
+    m_spill.write(reinterpret_cast<const char*>(&size), sizeof(size));
+    m_spill.write(m_buf.data(), static_cast<std::streamsize>(m_buf.size()));
+  }
+  auto key = type_key(msg);
+  auto now = clock_type::now();
+  std::lock_guard<std::mutex> guard{m_mtx};
+  roll_window(now);
+  auto& st = m_stats[key];
+  ++st.count;
+  ++st.window;
+  if (sized) {
+    st.bytes += m_buf.size();
+  } else {
+    ++st.unsized;
+  }
+  ++m_total;
+  // only pay for to_string on sampled messages
+  if (m_sampled_in_window < m_samples_per_sec) {
+    ++m_sampled_in_window;
+    if (m_samples.size() == max_samples) {
+      m_samples.pop_front();
+    }
+    m_samples.push_back(to_string(msg));
+  }
+}
+
+std::string capture_sink::type_key(const message& msg) {
+  std::string result = "(";
+  for (size_t i = 0; i < msg.size(); ++i) {
+    if (i > 0) {
+      result += ", ";
+    }
+    // atoms usually identify the message, hence we include their value
+    if (msg.match_element<atom_value>(i)) {
+      result += "'" + to_string(msg.get_as<atom_value>(i)) + "'";
+    } else {
+      result += msg.type_at(i)->name();
+    }
+  }
+  result += ")";
+  return result;
+}
+
+} // namespace cash
+} // namespace caf
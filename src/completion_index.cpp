@@ -0,0 +1,155 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/completion_index.hpp"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "caf/all.hpp"
+#include "caf/io/all.hpp"
+#include "caf/riac/all.hpp"
+
+namespace caf {
+namespace cash {
+
+namespace {
+
+struct indexer_state {
+  // hostname of each known node
+  std::map<node_id, std::string> hosts;
+  // nodes with an outstanding `NodeInfo` request
+  std::set<node_id> requested;
+  // node whose actor IDs are indexed
+  node_id current;
+  bool dirty = false;
+};
+
+void publish_nodes(indexer_state& st, completion_index& idx) {
+  if (!st.dirty || !st.requested.empty()) {
+    return;
+  }
+  std::vector<std::string> entries;
+  entries.reserve(st.hosts.size() * 3);
+  for (auto& kvp : st.hosts) {
+    entries.push_back(kvp.second);
+    entries.push_back(kvp.second + ":"
+                      + std::to_string(kvp.first.process_id()));
+    entries.push_back(to_string(kvp.first));
+  }
+  idx.set_nodes(std::make_shared<prefix_index>(std::move(entries)));
+  st.dirty = false;
+}
+
+void refresh_actors(const actor& indexer, const node_id& nid) {
+  if (nid == invalid_node_id) {
+    return;
+  }
+  auto mm = io::middleman::instance();
+  mm->run_later([indexer, nid, mm] {
+    auto bro = mm->get_named_broker<io::basp_broker>(atom("_BASP"));
+    auto proxies = bro->get_namespace().get_all(nid);
+    std::vector<actor_id> ids;
+    ids.reserve(proxies.size());
+    for (auto& p : proxies) {
+      ids.push_back(p->id());
+    }
+    anon_send(indexer, atom("Actors"), nid, std::move(ids));
+  });
+}
+
+behavior indexer(event_based_actor* self, actor nexus_proxy,
+                 std::shared_ptr<completion_index> idx) {
+  auto st = std::make_shared<indexer_state>();
+  self->send(self, atom("Tick"));
+  return {
+    on(atom("Tick")) >> [=] {
+      self->sync_send(nexus_proxy, atom("Nodes")).then(
+        [=](const std::vector<node_id>& nodes) {
+          std::set<node_id> alive(nodes.begin(), nodes.end());
+          for (auto i = st->hosts.begin(); i != st->hosts.end();) {
+            if (alive.count(i->first) == 0) {
+              i = st->hosts.erase(i);
+              st->dirty = true;
+            } else {
+              ++i;
+            }
+          }
+          // only ask for nodes we did not see before
+          for (auto& node : nodes) {
+            if (st->hosts.count(node) > 0 || st->requested.count(node) > 0) {
+              continue;
+            }
+            st->requested.insert(node);
+            self->sync_send(nexus_proxy, atom("NodeInfo"), node).then(
+              [=](const riac::node_info& ni) {
+                st->requested.erase(node);
+                st->hosts[node] = ni.hostname;
+                st->dirty = true;
+                publish_nodes(*st, *idx);
+              },
+              on(atom("NoNodeInfo")) >> [=] {
+                st->requested.erase(node);
+                publish_nodes(*st, *idx);
+              }
+            );
+          }
+          publish_nodes(*st, *idx);
+        }
+      );
+      refresh_actors(actor_cast<actor>(self), st->current);
+      self->delayed_send(self, indexer_interval, atom("Tick"));
+    },
+    on(atom("SetNode"), arg_match) >> [=](const node_id& nid) {
+      st->current = nid;
+      idx->set_actors(std::make_shared<prefix_index>());
+      refresh_actors(actor_cast<actor>(self), nid);
+    },
+    on(atom("Actors"), arg_match) >> [=](const node_id& nid,
+                                         const std::vector<actor_id>& ids) {
+      // drop results for a node we already left
+      if (nid != st->current) {
+        return;
+      }
+      std::vector<std::string> entries;
+      entries.reserve(ids.size());
+      for (auto id : ids) {
+        entries.push_back(std::to_string(id));
+      }
+      idx->set_actors(std::make_shared<prefix_index>(std::move(entries)));
+    }
+  };
+}
+
+} // namespace <anonymous>
+
+completion_index::completion_index()
+    : m_nodes(std::make_shared<prefix_index>()),
+      m_actors(std::make_shared<prefix_index>()) {
+  // nop
+}
+
+actor spawn_indexer(actor nexus_proxy, std::shared_ptr<completion_index> idx) {
+  return spawn(indexer, std::move(nexus_proxy), std::move(idx));
+}
+
+} // namespace cash
+} // namespace caf
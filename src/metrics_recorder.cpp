@@ -0,0 +1,112 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/metrics_recorder.hpp"
+
+#include <set>
+#include <cctype>
+#include <vector>
+
+#include "caf/all.hpp"
+#include "caf/riac/all.hpp"
+
+namespace caf {
+namespace cash {
+
+namespace {
+
+metrics_store::timestamp now_ms() {
+  using namespace std::chrono;
+  auto t = system_clock::now().time_since_epoch();
+  return duration_cast<milliseconds>(t).count();
+}
+
+behavior metrics_recorder(event_based_actor* self, actor nexus_proxy,
+                          std::shared_ptr<metrics_store> store,
+                          std::chrono::milliseconds interval) {
+  // nodes with a label in the store
+  auto labeled = std::make_shared<std::set<node_id>>();
+  self->send(self, atom("Tick"));
+  return {
+    on(atom("Tick")) >> [=] {
+      self->sync_send(nexus_proxy, atom("Nodes")).then(
+        [=](const std::vector<node_id>& nodes) {
+          for (auto& node : nodes) {
+            auto series = series_name(node);
+            if (labeled->count(node) == 0) {
+              self->sync_send(nexus_proxy, atom("NodeInfo"), node).then(
+                [=](const riac::node_info& ni) {
+                  labeled->insert(node);
+                  store->set_label(series, ni.hostname + ":"
+                                   + std::to_string(node.process_id()));
+                },
+                on(atom("NoNodeInfo")) >> [] {
+                  // try again next time
+                }
+              );
+            }
+            self->sync_send(nexus_proxy, atom("WorkLoad"), node).then(
+              [=](const riac::work_load& wl) {
+                auto ts = now_ms();
+                store->append(series, "cpu", ts, wl.cpu_load);
+                store->append(series, "actors", ts, wl.num_actors);
+              },
+              on(atom("NoWorkLoad")) >> [] {
+                // nop
+              }
+            );
+            self->sync_send(nexus_proxy, atom("RamUsage"), node).then(
+              [=](const riac::ram_usage& ru) {
+                store->append(series, "ram", now_ms(),
+                              static_cast<double>(ru.in_use));
+              },
+              on(atom("NoRamUsage")) >> [] {
+                // nop
+              }
+            );
+          }
+        }
+      );
+      self->delayed_send(self, interval, atom("Tick"));
+    }
+  };
+}
+
+} // namespace <anonymous>
+
+std::string series_name(const node_id& node) {
+  // node IDs contain characters we do not want in directory names
+  auto result = to_string(node);
+  for (auto& c : result) {
+    if (!isalnum(static_cast<unsigned char>(c))) {
+      c = '_';
+    }
+  }
+  return result;
+}
+
+actor spawn_metrics_recorder(actor nexus_proxy,
+                             std::shared_ptr<metrics_store> store,
+                             std::chrono::milliseconds interval) {
+  return spawn(metrics_recorder, std::move(nexus_proxy), std::move(store),
+               interval);
+}
+
+} // namespace cash
+} // namespace caf
@@ -0,0 +1,727 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/metrics_store.hpp"
+
+#include <ctime>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <algorithm>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace caf {
+namespace cash {
+
+namespace {
+
+using timestamp = metrics_store::timestamp;
+
+// size of a serialized `block_info`
+constexpr size_t block_info_size = 56;
+
+class bit_writer {
+ public:
+  bit_writer() : m_free(0) {
+    // nop
+  }
+
+  void write(uint64_t bits, unsigned n) {
+    while (n > 0) {
+      if (m_free == 0) {
+        m_buf.push_back(0);
+        m_free = 8;
+      }
+      auto k = std::min(n, m_free);
+      auto chunk = static_cast<uint8_t>((bits >> (n - k)) & ((1u << k) - 1));
+      m_buf.back() = static_cast<char>(static_cast<uint8_t>(m_buf.back())
+                                       | (chunk << (m_free - k)));
+      m_free -= k;
+      n -= k;
+    }
+  }
+
+  std::vector<char>& buf() {
+    return m_buf;
+  }
+
+ private:
+  std::vector<char> m_buf;
+  unsigned m_free;
+};
+
+class bit_reader {
+ public:
+  bit_reader(const char* data, size_t size)
+      : m_data(reinterpret_cast<const uint8_t*>(data)),
+        m_size(size * 8),
+        m_pos(0) {
+    // nop
+  }
+
+  bool read(unsigned n, uint64_t& result) {
+    if (m_pos + n > m_size) {
+      return false;
+    }
+    result = 0;
+    while (n > 0) {
+      auto avail = 8 - static_cast<unsigned>(m_pos % 8);
+      auto k = std::min(n, avail);
+      auto byte = m_data[m_pos / 8];
+      auto chunk = (byte >> (avail - k)) & ((1u << k) - 1);
+      result = (result << k) | chunk;
+      m_pos += k;
+      n -= k;
+    }
+    return true;
+  }
+
+  bool read_bit(bool& result) {
+    uint64_t x;
+    if (!read(1, x)) {
+      return false;
+    }
+    result = x != 0;
+    return true;
+  }
+
+ private:
+  const uint8_t* m_data;
+  size_t m_size;
+  size_t m_pos;
+};
+
+uint64_t to_bits(double x) {
+  uint64_t result;
+  memcpy(&result, &x, sizeof(double));
+  return result;
+}
+
+double from_bits(uint64_t x) {
+  double result;
+  memcpy(&result, &x, sizeof(double));
+  return result;
+}
+
+unsigned leading_zeros(uint64_t x) {
+  unsigned n = 0;
+  for (uint64_t mask = uint64_t{1} << 63; (x & mask) == 0; mask >>= 1) {
+    ++n;
+  }
+  return n;
+}
+
+unsigned trailing_zeros(uint64_t x) {
+  unsigned n = 0;
+  for (; (x & 1) == 0; x >>= 1) {
+    ++n;
+  }
+  return n;
+}
+
+// encodes timestamps as delta-of-delta and values as XOR with their
+// predecessor, both using variable-length prefix codes
+std::vector<char> encode_block(const std::vector<timestamp>& times,
+                               const std::vector<double>& values) {
+  bit_writer out;
+  timestamp prev_ts = 0;
+  timestamp prev_delta = 0;
+  uint64_t prev_val = 0;
+  unsigned prev_lead = 0;
+  unsigned prev_trail = 0;
+  bool have_window = false;
+  for (size_t i = 0; i < times.size(); ++i) {
+    auto val = to_bits(values[i]);
+    if (i == 0) {
+      out.write(static_cast<uint64_t>(times[i]), 64);
+      out.write(val, 64);
+      prev_ts = times[i];
+      prev_val = val;
+      continue;
+    }
+    auto delta = times[i] - prev_ts;
+    auto dod = delta - prev_delta;
+    if (dod == 0) {
+      out.write(0x00, 1);
+    } else if (dod >= -63 && dod <= 64) {
+      out.write(0x02, 2);
+      out.write(static_cast<uint64_t>(dod + 63), 7);
+    } else if (dod >= -255 && dod <= 256) {
+      out.write(0x06, 3);
+      out.write(static_cast<uint64_t>(dod + 255), 9);
+    } else if (dod >= -2047 && dod <= 2048) {
+      out.write(0x0E, 4);
+      out.write(static_cast<uint64_t>(dod + 2047), 12);
+    } else {
+      out.write(0x0F, 4);
+      out.write(static_cast<uint64_t>(dod), 64);
+    }
+    prev_ts = times[i];
+    prev_delta = delta;
+    auto x = val ^ prev_val;
+    prev_val = val;
+    if (x == 0) {
+      out.write(0x00, 1);
+      continue;
+    }
+    out.write(0x01, 1);
+    auto lead = std::min(leading_zeros(x), 31u);
+    auto trail = trailing_zeros(x);
+    if (have_window && lead >= prev_lead && trail >= prev_trail) {
+      // meaningful bits fit into the previous window
+      out.write(0x00, 1);
+      out.write(x >> prev_trail, 64 - prev_lead - prev_trail);
+    } else {
+      auto meaningful = 64 - lead - trail;
+      out.write(0x01, 1);
+      out.write(lead, 5);
+      out.write(meaningful - 1, 6);
+      out.write(x >> trail, meaningful);
+      prev_lead = lead;
+      prev_trail = trail;
+      have_window = true;
+    }
+  }
+  return std::move(out.buf());
+}
+
+template <class F>
+bool decode_block(const char* data, size_t size, uint32_t count, F f) {
+  bit_reader in{data, size};
+  uint64_t ts;
+  uint64_t val;
+  if (count == 0) {
+    return true;
+  }
+  if (!in.read(64, ts) || !in.read(64, val)) {
+    return false;
+  }
+  f(static_cast<timestamp>(ts), from_bits(val));
+  timestamp prev_ts = static_cast<timestamp>(ts);
+  timestamp prev_delta = 0;
+  unsigned prev_lead = 0;
+  unsigned prev_trail = 0;
+  for (uint32_t i = 1; i < count; ++i) {
+    // number of leading 1s selects the encoding of the delta-of-delta
+    unsigned ones = 0;
+    bool b;
+    do {
+      if (!in.read_bit(b)) {
+        return false;
+      }
+    } while (b && ++ones < 4);
+    timestamp dod;
+    uint64_t x;
+    switch (ones) {
+      case 0:
+        dod = 0;
+        break;
+      case 1:
+        if (!in.read(7, x)) {
+          return false;
+        }
+        dod = static_cast<timestamp>(x) - 63;
+        break;
+      case 2:
+        if (!in.read(9, x)) {
+          return false;
+        }
+        dod = static_cast<timestamp>(x) - 255;
+        break;
+      case 3:
+        if (!in.read(12, x)) {
+          return false;
+        }
+        dod = static_cast<timestamp>(x) - 2047;
+        break;
+      default:
+        if (!in.read(64, x)) {
+          return false;
+        }
+        dod = static_cast<timestamp>(x);
+    }
+    prev_delta += dod;
+    prev_ts += prev_delta;
+    if (!in.read_bit(b)) {
+      return false;
+    }
+    if (b) {
+      if (!in.read_bit(b)) {
+        return false;
+      }
+      if (b) {
+        uint64_t lead;
+        uint64_t meaningful;
+        if (!in.read(5, lead) || !in.read(6, meaningful)) {
+          return false;
+        }
+        prev_lead = static_cast<unsigned>(lead);
+        prev_trail = 64 - prev_lead - static_cast<unsigned>(meaningful + 1);
+      }
+      if (!in.read(64 - prev_lead - prev_trail, x)) {
+        return false;
+      }
+      val ^= x << prev_trail;
+    }
+    f(prev_ts, from_bits(val));
+  }
+  return true;
+}
+
+void write_info(std::ostream& out, const metrics_store::block_info& bi) {
+  char buf[block_info_size];
+  auto pos = buf;
+  auto put = [&](const void* x, size_t n) {
+    memcpy(pos, x, n);
+    pos += n;
+  };
+  put(&bi.t_min, 8);
+  put(&bi.t_max, 8);
+  put(&bi.v_min, 8);
+  put(&bi.v_max, 8);
+  put(&bi.v_sum, 8);
+  put(&bi.count, 4);
+  put(&bi.size, 4);
+  put(&bi.offset, 8);
+  out.write(buf, block_info_size);
+}
+
+void read_info(const char* buf, metrics_store::block_info& bi) {
+  auto get = [&](void* x, size_t n) {
+    memcpy(x, buf, n);
+    buf += n;
+  };
+  get(&bi.t_min, 8);
+  get(&bi.t_max, 8);
+  get(&bi.v_min, 8);
+  get(&bi.v_max, 8);
+  get(&bi.v_sum, 8);
+  get(&bi.count, 4);
+  get(&bi.size, 4);
+  get(&bi.offset, 8);
+}
+
+bool make_dir(const std::string& path) {
+  return mkdir(path.c_str(), 0755) == 0 || errno == EEXIST;
+}
+
+class aggregator {
+ public:
+  aggregator(timestamp from, timestamp to, timestamp step)
+      : m_from(from),
+        m_to(to),
+        m_step(step) {
+    auto n = to > from ? (to - from + step - 1) / step : 0;
+    m_buckets.resize(static_cast<size_t>(n));
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+      m_buckets[i].start = from + static_cast<timestamp>(i) * step;
+      m_buckets[i].count = 0;
+    }
+  }
+
+  inline size_t bucket_of(timestamp ts) const {
+    return static_cast<size_t>((ts - m_from) / m_step);
+  }
+
+  inline bool contains(timestamp ts) const {
+    return ts >= m_from && ts < m_to;
+  }
+
+  void add(timestamp ts, double value) {
+    if (!contains(ts)) {
+      return;
+    }
+    add(bucket_of(ts), value, value, value, 1);
+  }
+
+  void add(size_t pos, double min, double max, double sum, uint64_t count) {
+    auto& b = m_buckets[pos];
+    if (b.count == 0) {
+      b.min = min;
+      b.max = max;
+      b.sum = sum;
+    } else {
+      b.min = std::min(b.min, min);
+      b.max = std::max(b.max, max);
+      b.sum += sum;
+    }
+    b.count += count;
+  }
+
+  std::vector<metrics_store::bucket> result() const {
+    std::vector<metrics_store::bucket> xs;
+    for (auto& b : m_buckets) {
+      if (b.count > 0) {
+        xs.push_back(b);
+      }
+    }
+    return xs;
+  }
+
+ private:
+  timestamp m_from;
+  timestamp m_to;
+  timestamp m_step;
+  std::vector<metrics_store::bucket> m_buckets;
+};
+
+} // namespace <anonymous>
+
+constexpr uint32_t metrics_store::block_size;
+constexpr size_t metrics_store::max_buckets;
+constexpr size_t metrics_store::max_wal_size;
+
+metrics_store::metrics_store(std::string root, bool read_only)
+    : m_root(std::move(root)),
+      m_read_only(read_only) {
+  if (m_read_only) {
+    struct stat st;
+    m_good = stat(m_root.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    if (m_good) {
+      // make samples of open blocks visible without touching any file
+      replay();
+    }
+    return;
+  }
+  m_good = make_dir(m_root);
+  if (!m_good) {
+    return;
+  }
+  // recover samples of blocks that were still open when we stopped
+  replay();
+  // write recovered samples to blocks and start with an empty log
+  std::lock_guard<std::mutex> guard{m_mtx};
+  checkpoint();
+}
+
+metrics_store::~metrics_store() {
+  flush();
+}
+
+void metrics_store::replay() {
+  std::ifstream in{m_root + "/wal", std::ios::binary};
+  std::map<uint32_t, key_type> keys;
+  char tag;
+  uint32_t id;
+  while (in.get(tag) && in.read(reinterpret_cast<char*>(&id), sizeof(id))) {
+    if (tag == 'K') {
+      key_type key;
+      uint32_t len;
+      if (!in.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+        break;
+      }
+      key.first.resize(len);
+      if (!in.read(&key.first[0], len)
+          || !in.read(reinterpret_cast<char*>(&len), sizeof(len))) {
+        break;
+      }
+      key.second.resize(len);
+      if (!in.read(&key.second[0], len)) {
+        break;
+      }
+      keys[id] = std::move(key);
+    } else if (tag == 'S') {
+      timestamp ts;
+      double value;
+      if (!in.read(reinterpret_cast<char*>(&ts), sizeof(ts))
+          || !in.read(reinterpret_cast<char*>(&value), sizeof(value))
+          || keys.count(id) == 0) {
+        break;
+      }
+      auto& blk = m_open[keys[id]];
+      blk.times.push_back(ts);
+      blk.values.push_back(value);
+    } else if (tag == 'C' && keys.count(id) > 0) {
+      auto& blk = m_open[keys[id]];
+      blk.times.clear();
+      blk.values.clear();
+    } else {
+      break;
+    }
+  }
+  in.close();
+}
+
+std::string metrics_store::path(const std::string& series,
+                                const std::string& metric,
+                                const char* suffix) const {
+  return m_root + "/" + series + "/" + metric + suffix;
+}
+
+void metrics_store::set_label(const std::string& series,
+                              const std::string& label) {
+  if (m_read_only) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard{m_mtx};
+  auto& x = m_labels[series];
+  if (x == label) {
+    return;
+  }
+  x = label;
+  make_dir(m_root + "/" + series);
+  std::ofstream out{m_root + "/" + series + "/label", std::ios::trunc};
+  out << label;
+}
+
+void metrics_store::append(const std::string& series,
+                           const std::string& metric, timestamp ts,
+                           double value) {
+  if (m_read_only) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard{m_mtx};
+  auto key = std::make_pair(series, metric);
+  auto& blk = m_open[key];
+  if (!blk.times.empty() && ts < blk.times.back()) {
+    // keep each block sorted by time
+    return;
+  }
+  blk.times.push_back(ts);
+  blk.values.push_back(value);
+  if (blk.times.size() == block_size) {
+    seal(key, blk);
+  }
+  log(key, ts, value);
+}
+
+void metrics_store::log(const key_type& key, timestamp ts, double value) {
+  if (!m_wal.is_open()) {
+    return;
+  }
+  auto put = [&](const void* x, size_t n) {
+    m_wal.write(reinterpret_cast<const char*>(x),
+                static_cast<std::streamsize>(n));
+  };
+  auto i = m_wal_keys.find(key);
+  if (i == m_wal_keys.end()) {
+    auto id = static_cast<uint32_t>(m_wal_keys.size());
+    i = m_wal_keys.emplace(key, id).first;
+    auto slen = static_cast<uint32_t>(key.first.size());
+    auto mlen = static_cast<uint32_t>(key.second.size());
+    m_wal.put('K');
+    put(&id, sizeof(id));
+    put(&slen, sizeof(slen));
+    put(key.first.data(), slen);
+    put(&mlen, sizeof(mlen));
+    put(key.second.data(), mlen);
+  }
+  if (m_open[key].times.empty()) {
+    // the block was just sealed, drop its samples on replay
+    m_wal.put('C');
+    put(&i->second, sizeof(uint32_t));
+  } else {
+    m_wal.put('S');
+    put(&i->second, sizeof(uint32_t));
+    put(&ts, sizeof(ts));
+    put(&value, sizeof(value));
+  }
+  // hand each record to the OS, so that it survives the shell getting killed
+  m_wal.flush();
+  if (m_wal.tellp() > static_cast<std::streamoff>(max_wal_size)) {
+    checkpoint();
+  }
+}
+
+void metrics_store::checkpoint() {
+  for (auto& kvp : m_open) {
+    seal(kvp.first, kvp.second);
+  }
+  m_wal_keys.clear();
+  if (m_wal.is_open()) {
+    m_wal.close();
+  }
+  m_wal.open(m_root + "/wal", std::ios::binary | std::ios::trunc);
+}
+
+void metrics_store::flush() {
+  std::lock_guard<std::mutex> guard{m_mtx};
+  if (m_good && !m_read_only) {
+    checkpoint();
+  }
+}
+
+void metrics_store::seal(const key_type& key, open_block& blk) {
+  if (blk.times.empty()) {
+    return;
+  }
+  make_dir(m_root + "/" + key.first);
+  auto payload = encode_block(blk.times, blk.values);
+  std::ofstream dat{path(key.first, key.second, ".dat"),
+                    std::ios::binary | std::ios::app};
+  dat.seekp(0, std::ios::end);
+  block_info bi;
+  bi.offset = static_cast<uint64_t>(dat.tellp());
+  bi.size = static_cast<uint32_t>(payload.size());
+  bi.count = static_cast<uint32_t>(blk.times.size());
+  bi.t_min = blk.times.front();
+  bi.t_max = blk.times.back();
+  bi.v_min = *std::min_element(blk.values.begin(), blk.values.end());
+  bi.v_max = *std::max_element(blk.values.begin(), blk.values.end());
+  bi.v_sum = 0;
+  for (auto v : blk.values) {
+    bi.v_sum += v;
+  }
+  // write data before its index entry, so that the index
+  // never points to a block that does not exist
+  dat.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+  dat.close();
+  if (!dat) {
+    return;
+  }
+  std::ofstream idx{path(key.first, key.second, ".idx"),
+                    std::ios::binary | std::ios::app};
+  write_info(idx, bi);
+  blk.times.clear();
+  blk.values.clear();
+}
+
+std::vector<std::pair<std::string, std::string>> metrics_store::series() const {
+  std::vector<std::pair<std::string, std::string>> result;
+  auto dir = opendir(m_root.c_str());
+  if (!dir) {
+    return result;
+  }
+  while (auto entry = readdir(dir)) {
+    std::string name = entry->d_name;
+    if (name == "." || name == "..") {
+      continue;
+    }
+    std::ifstream in{m_root + "/" + name + "/label"};
+    if (!in) {
+      continue;
+    }
+    std::string label{std::istreambuf_iterator<char>(in),
+                      std::istreambuf_iterator<char>()};
+    result.emplace_back(std::move(name), std::move(label));
+  }
+  closedir(dir);
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+std::vector<metrics_store::bucket>
+metrics_store::query(const std::string& series, const std::string& metric,
+                     timestamp from, timestamp to, timestamp step) const {
+  // widen the step if the range would need too many buckets
+  auto n = static_cast<timestamp>(max_buckets);
+  auto min_step = to > from ? (to - from + n - 1) / n : timestamp{1};
+  aggregator agg{from, to, std::max(step, min_step)};
+  std::ifstream idx{path(series, metric, ".idx"), std::ios::binary};
+  std::ifstream dat{path(series, metric, ".dat"), std::ios::binary};
+  char buf[block_info_size];
+  std::vector<char> payload;
+  while (idx.read(buf, block_info_size)) {
+    block_info bi;
+    read_info(buf, bi);
+    if (bi.t_max < from || bi.t_min >= to) {
+      continue;
+    }
+    if (agg.contains(bi.t_min) && agg.contains(bi.t_max)
+        && agg.bucket_of(bi.t_min) == agg.bucket_of(bi.t_max)) {
+      // the whole block falls into one bucket, no need to decode it
+      agg.add(agg.bucket_of(bi.t_min), bi.v_min, bi.v_max, bi.v_sum,
+              bi.count);
+      continue;
+    }
+    payload.resize(bi.size);
+    dat.seekg(static_cast<std::streamoff>(bi.offset));
+    if (!dat.read(payload.data(), static_cast<std::streamsize>(bi.size))) {
+      break;
+    }
+    decode_block(payload.data(), payload.size(), bi.count,
+                 [&](timestamp ts, double value) {
+      agg.add(ts, value);
+    });
+  }
+  // samples not yet written to disk
+  std::lock_guard<std::mutex> guard{m_mtx};
+  auto i = m_open.find(std::make_pair(series, metric));
+  if (i != m_open.end()) {
+    for (size_t j = 0; j < i->second.times.size(); ++j) {
+      agg.add(i->second.times[j], i->second.values[j]);
+    }
+  }
+  return agg.result();
+}
+
+bool parse_duration(const std::string& str, timestamp& result) {
+  char* end;
+  auto n = strtoll(str.c_str(), &end, 10);
+  if (end == str.c_str() || n < 0) {
+    return false;
+  }
+  std::string unit{end};
+  timestamp factor;
+  if (unit == "ms") {
+    factor = 1;
+  } else if (unit == "s") {
+    factor = 1000;
+  } else if (unit == "m") {
+    factor = 60 * 1000;
+  } else if (unit == "h") {
+    factor = 60 * 60 * 1000;
+  } else if (unit == "d") {
+    factor = 24 * 60 * 60 * 1000;
+  } else if (unit == "w") {
+    factor = 7 * 24 * 60 * 60 * 1000;
+  } else {
+    return false;
+  }
+  result = n * factor;
+  return true;
+}
+
+bool parse_time(const std::string& str, timestamp now, timestamp& result) {
+  if (str == "now") {
+    result = now;
+    return true;
+  }
+  if (!str.empty() && str.front() == '-') {
+    timestamp d;
+    if (!parse_duration(str.substr(1), d)) {
+      return false;
+    }
+    result = now - d;
+    return true;
+  }
+  if (!str.empty() && std::all_of(str.begin(), str.end(), ::isdigit)) {
+    result = strtoll(str.c_str(), nullptr, 10) * 1000;
+    return true;
+  }
+  const char* formats[] = {"%Y-%m-%dT%H:%M:%S", "%Y-%m-%dT%H:%M", "%Y-%m-%d"};
+  for (auto fmt : formats) {
+    tm t;
+    memset(&t, 0, sizeof(tm));
+    auto end = strptime(str.c_str(), fmt, &t);
+    if (end && *end == '\0') {
+      result = static_cast<timestamp>(timegm(&t)) * 1000;
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace cash
+} // namespace caf
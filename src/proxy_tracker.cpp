@@ -0,0 +1,137 @@
+/******************************************************************************
+ *                       ____    _    _____                                   *
+ *                      / ___|  / \  |  ___|    C++                           *
+ *                     | |     / _ \ | |_       Actor                         *
+ *                     | |___ / ___ \|  _|      Framework                     *
+ *                      \____/_/   \_|_|                                      *
+ *                                                                            *
+ * Copyright (C) 2011 - 2015                                                  *
+ * Dominik Charousset <dominik.charousset (at) haw-hamburg.de>                *
+ *                                                                            *
+ * Distributed under the terms and conditions of the BSD 3-Clause License or  *
+ * (at your option) under the terms and conditions of the Boost Software      *
+ * License 1.0. See accompanying files LICENSE and LICENSE_ALTERNATIVE.       *
+ *                                                                            *
+ * If you did not receive a copy of the license files, see                    *
+ * http://opensource.org/licenses/BSD-3-Clause and                            *
+ * http://www.boost.org/LICENSE_1_0.txt.                                      *
+ ******************************************************************************/
+
+#include "caf/cash/proxy_tracker.hpp"
+
+#include <set>
+#include <utility>
+
+#include "caf/all.hpp"
+#include "caf/io/all.hpp"
+
+namespace caf {
+namespace cash {
+
+constexpr size_t proxy_tracker::max_history;
+constexpr size_t proxy_tracker::min_samples;
+
+void proxy_tracker::sample_all(const std::vector<node_id>& nodes) {
+  auto now = clock_type::now();
+  auto mm = io::middleman::instance();
+  auto bro = mm->get_named_broker<io::basp_broker>(atom("_BASP"));
+  auto& ns = bro->get_namespace();
+  std::vector<std::pair<node_id, sample>> samples;
+  samples.reserve(nodes.size());
+  for (auto& nid : nodes) {
+    samples.emplace_back(nid, sample{now, ns.count_proxies(nid)});
+  }
+  std::set<node_id> alive(nodes.begin(), nodes.end());
+  std::lock_guard<std::mutex> guard{m_mtx};
+  for (auto i = m_history.begin(); i != m_history.end();) {
+    if (alive.count(i->first) == 0) {
+      i = m_history.erase(i);
+    } else {
+      ++i;
+    }
+  }
+  for (auto& s : samples) {
+    auto& hist = m_history[s.first];
+    if (hist.size() == max_history) {
+      hist.pop_front();
+    }
+    hist.push_back(s.second);
+  }
+}
+
+std::vector<proxy_tracker::trend> proxy_tracker::trends() const {
+  std::vector<trend> result;
+  std::lock_guard<std::mutex> guard{m_mtx};
+  for (auto& kvp : m_history) {
+    auto& hist = kvp.second;
+    if (hist.empty()) {
+      continue;
+    }
+    trend t;
+    t.node = kvp.first;
+    t.count = hist.back().count;
+    t.growth = static_cast<long>(hist.back().count)
+               - static_cast<long>(hist.front().count);
+    t.rising = 0;
+    t.falling = 0;
+    t.samples = hist.size();
+    // least-squares fit of count over time (in minutes)
+    double sx = 0;
+    double sy = 0;
+    double sxx = 0;
+    double sxy = 0;
+    for (size_t i = 0; i < hist.size(); ++i) {
+      std::chrono::duration<double, std::ratio<60>> x =
+        hist[i].time - hist.front().time;
+      auto y = static_cast<double>(hist[i].count);
+      sx += x.count();
+      sy += y;
+      sxx += x.count() * x.count();
+      sxy += x.count() * y;
+      if (i > 0 && hist[i].count > hist[i - 1].count) {
+        ++t.rising;
+      } else if (i > 0 && hist[i].count < hist[i - 1].count) {
+        ++t.falling;
+      }
+    }
+    auto n = static_cast<double>(hist.size());
+    auto denom = n * sxx - sx * sx;
+    t.slope = denom > 0 ? (n * sxy - sx * sy) / denom : 0.;
+    t.steady = hist.size() >= min_samples && t.growth > 0
+               && t.rising * 4 >= (hist.size() - 1) * 3;
+    result.push_back(t);
+  }
+  return result;
+}
+
+namespace {
+
+behavior proxy_sampler(event_based_actor* self, actor nexus_proxy,
+                       std::shared_ptr<proxy_tracker> tracker,
+                       std::chrono::milliseconds interval) {
+  self->send(self, atom("Tick"));
+  return {
+    on(atom("Tick")) >> [=] {
+      self->sync_send(nexus_proxy, atom("Nodes")).then(
+        [=](const std::vector<node_id>& nodes) {
+          io::middleman::instance()->run_later([=] {
+            tracker->sample_all(nodes);
+          });
+        }
+      );
+      self->delayed_send(self, interval, atom("Tick"));
+    }
+  };
+}
+
+} // namespace <anonymous>
+
+actor spawn_proxy_tracker(actor nexus_proxy,
+                          std::shared_ptr<proxy_tracker> tracker,
+                          std::chrono::milliseconds interval) {
+  return spawn(proxy_sampler, std::move(nexus_proxy), std::move(tracker),
+               interval);
+}
+
+} // namespace cash
+} // namespace caf
@@ -19,17 +19,30 @@
 
 #include "caf/cash/shell.hpp"
 
+#include <map>
+#include <set>
+#include <ctime>
+#include <deque>
+#include <future>
+#include <limits>
 #include <thread>
 #include <vector>
 #include <chrono>
+#include <numeric>
+#include <sstream>
+#include <iomanip>
 #include <iterator>
 #include <iostream>
 #include <algorithm>
 
 #include "caf/io/all.hpp"
 #include "caf/io/network/protocol.hpp"
+#include "caf/binary_serializer.hpp"
+#include "caf/binary_deserializer.hpp"
 #include "caf/riac/nexus_proxy.hpp"
 
+#include "caf/cash/metrics_recorder.hpp"
+
 using std::cout;
 using std::endl;
 using std::setw;
@@ -40,6 +53,24 @@ using caf::io::network::protocol;
 
 namespace {
 
+std::vector<std::string> split_args(std::string::const_iterator first,
+                                    std::string::const_iterator last) {
+  std::vector<std::string> result;
+  std::istringstream iss{std::string(first, last)};
+  std::copy(std::istream_iterator<std::string>(iss),
+            std::istream_iterator<std::string>(), std::back_inserter(result));
+  return result;
+}
+
+std::string format_time(int64_t ms) {
+  auto secs = static_cast<time_t>(ms / 1000);
+  tm t;
+  gmtime_r(&secs, &t);
+  char buf[32];
+  strftime(buf, sizeof(buf), "%Y-%m-%d %H:%M:%S", &t);
+  return buf;
+}
+
 std::string progressbar(size_t percent, char sign = '#', int amount = 50) {
   // make sure percent is in between 0 and 100
   percent = std::min(std::max(percent, size_t{0}), size_t{100});
@@ -51,12 +82,137 @@ std::string progressbar(size_t percent, char sign = '#', int amount = 50) {
   return s.str();
 }
 
+// formats `x` with a fixed number of decimals without touching `cout`
+std::string format_fixed(double x, int precision) {
+  std::ostringstream s;
+  s << std::fixed << std::setprecision(precision) << x;
+  return s.str();
+}
+
+// measures the serialization of a message on the middleman's thread,
+// running one batch per `run_later` to not block the middleman for long
+struct profile_job : std::enable_shared_from_this<profile_job> {
+  using clock_type = std::chrono::steady_clock;
+
+  // repeat until we have a stable average, but at least 100 times
+  static constexpr size_t min_iterations = 100;
+  // reading the clock is not free, only do so once per batch
+  static constexpr size_t batch_size = 64;
+
+  struct timing {
+    size_t iterations = 0;
+    clock_type::duration elapsed = clock_type::duration::zero();
+
+    bool done() const {
+      return iterations >= min_iterations
+             && elapsed >= std::chrono::milliseconds(200);
+    }
+  };
+
+  struct result {
+    std::string error;
+    size_t wire_size = 0;
+    // type name and serialized size of each element
+    std::vector<std::pair<std::string, size_t>> elements;
+    timing encode;
+    timing decode;
+  };
+
+  explicit profile_job(caf::message x) : msg(std::move(x)) {
+    // nop
+  }
+
+  void schedule() {
+    auto self = shared_from_this();
+    caf::io::middleman::instance()->run_later([self] { self->step(); });
+  }
+
+  void step() {
+    using namespace caf;
+    auto mm = io::middleman::instance();
+    auto& ns = mm->get_named_broker<io::basp_broker>(atom("_BASP"))
+                 ->get_namespace();
+    try {
+      if (buf.empty()) {
+        binary_serializer bs(std::back_inserter(buf), &ns);
+        bs << msg;
+        res.wire_size = buf.size();
+        for (size_t i = 0; i < msg.size(); ++i) {
+          std::vector<char> elem;
+          binary_serializer ebs(std::back_inserter(elem), &ns);
+          auto uti = msg.type_at(i);
+          uti->serialize(msg.at(i), &ebs);
+          res.elements.emplace_back(uti->name(), elem.size());
+        }
+        tmp.reserve(buf.size());
+      } else if (!res.encode.done()) {
+        auto start = clock_type::now();
+        for (size_t i = 0; i < batch_size; ++i) {
+          tmp.clear();
+          binary_serializer sink(std::back_inserter(tmp), &ns);
+          sink << msg;
+        }
+        res.encode.elapsed += clock_type::now() - start;
+        res.encode.iterations += batch_size;
+      } else {
+        auto start = clock_type::now();
+        for (size_t i = 0; i < batch_size; ++i) {
+          message x;
+          binary_deserializer source(buf.data(), buf.size(), &ns);
+          uniform_typeid<message>()->deserialize(&x, &source);
+        }
+        res.decode.elapsed += clock_type::now() - start;
+        res.decode.iterations += batch_size;
+        if (res.decode.done()) {
+          done.set_value(std::move(res));
+          return;
+        }
+      }
+    } catch (std::exception& e) {
+      res.error = e.what();
+      done.set_value(std::move(res));
+      return;
+    }
+    schedule();
+  }
+
+  caf::message msg;
+  std::vector<char> buf;
+  std::vector<char> tmp;
+  result res;
+  std::promise<result> done;
+};
+
+constexpr size_t profile_job::min_iterations;
+constexpr size_t profile_job::batch_size;
+
+// time to wait for each probe and lookup of the traceroute command
+constexpr auto traceroute_timeout = std::chrono::seconds(2);
+
+// no node ever assigns this ID, hence the BASP broker of the receiving
+// node bounces each request to it with a `sync_exited_msg`, without
+// involving any actor on that node
+constexpr auto traceroute_actor_id = std::numeric_limits<caf::actor_id>::max();
+
+// maximum number of candidates returned by a single completion
+constexpr size_t max_completions = 256;
+
+template <class Clauses>
+void add_command_names(std::vector<std::string>& out, const Clauses& xs) {
+  for (auto& x : xs) {
+    out.push_back(x.name);
+  }
+}
+
 } // namespace <anonymous>
 
 namespace caf {
 namespace cash {
 
-shell::shell() : m_done(false), m_engine(sash::variables_engine<>::create()) {
+shell::shell()
+    : m_done(false),
+      m_engine(sash::variables_engine<>::create()),
+      m_completion(std::make_shared<completion_index>()) {
   // register global commands
   std::vector<cli_type::mode_type::cmd_clause> global_cmds {
     {"quit",          "terminates the whole thing",    cb(&shell::quit)},
@@ -71,7 +227,14 @@ shell::shell() : m_done(false), m_engine(sash::variables_engine<>::create()) {
     {"change-node",   "switch between nodes",          cb(&shell::change_node)},
     {"dequeue",       "removes element from mailbox",  cb(&shell::dequeue)},
     {"pop-front",     "removes oldest mailbox element",cb(&shell::pop_front)},
-    {"await-msg",     "awaits and prints a message",   cb(&shell::await_msg)}
+    {"await-msg",     "awaits and prints a message",   cb(&shell::await_msg)},
+    {"capture",       "drains mailbox in background",  cb(&shell::capture)},
+    {"find-addr",     "finds nodes by IP, MAC or CIDR",cb(&shell::find_addr)},
+    {"proxy-growth",  "tracks proxy counts per node",  cb(&shell::proxy_growth)},
+    {"record",        "records node metrics to disk",  cb(&shell::record)},
+    {"query",         "queries recorded node metrics", cb(&shell::query)},
+    {"profile-msg",   "prints serialization costs",    cb(&shell::profile_msg)},
+    {"traceroute",    "prints hops and their latency", cb(&shell::traceroute)}
   };
   std::vector<cli_type::mode_type::cmd_clause> node_cmds {
     {"whereami",      "prints current node",           cb(&shell::whereami)},
@@ -90,6 +253,15 @@ shell::shell() : m_done(false), m_engine(sash::variables_engine<>::create()) {
   node_mode->add_all(global_cmds);
   node_mode->add_all(node_cmds);
   m_cli.add_preprocessor(m_engine->as_functor());
+  std::vector<std::string> names;
+  add_command_names(names, global_cmds);
+  m_global_cmds = prefix_index{names};
+  add_command_names(names, node_cmds);
+  m_node_cmds = prefix_index{std::move(names)};
+  m_cli.set_completer([=](const std::string& line,
+                          std::vector<std::string>& out) {
+    complete(line, out);
+  });
   m_cli.mode_push("global");
   m_nexus_proxy = spawn<riac::nexus_proxy>();
 }
@@ -102,6 +274,8 @@ void shell::run(riac::nexus_type nexus) {
       cout << " done" << endl;
     }
   );
+  m_nexus_node = nexus->node();
+  m_indexer = spawn_indexer(m_nexus_proxy, m_completion);
   std::string line;
   while (!m_done) {
     m_cli.read_line(line);
@@ -119,9 +293,40 @@ void shell::run(riac::nexus_type nexus) {
         break;
     }
   }
+  m_capture.reset();
+  if (m_proxy_sampler != invalid_actor) {
+    anon_send_exit(m_proxy_sampler, exit_reason::user_shutdown);
+  }
+  if (m_recorder != invalid_actor) {
+    anon_send_exit(m_recorder, exit_reason::user_shutdown);
+  }
+  if (m_address_refresher != invalid_actor) {
+    anon_send_exit(m_address_refresher, exit_reason::user_shutdown);
+  }
+  anon_send_exit(m_indexer, exit_reason::user_shutdown);
   anon_send_exit(m_nexus_proxy, exit_reason::user_shutdown);
 }
 
+void shell::complete(const std::string& line, std::vector<std::string>& out) {
+  auto ws = line.find(' ');
+  if (ws == std::string::npos) {
+    auto& cmds = m_node_stack.empty() ? m_global_cmds : m_node_cmds;
+    cmds.complete(line, out, max_completions);
+    return;
+  }
+  auto arg = line.substr(ws + 1);
+  if (arg.find(' ') != std::string::npos) {
+    // only the first argument is completed
+    return;
+  }
+  auto cmd = line.substr(0, ws);
+  if (cmd == "change-node") {
+    m_completion->nodes()->complete(arg, out, max_completions);
+  } else if (cmd == "send" && !m_node_stack.empty()) {
+    m_completion->actors()->complete(arg, out, max_completions);
+  }
+}
+
 void shell::quit(char_iter first, char_iter last) {
   if (!assert_empty(first, last)) {
     return;
@@ -286,7 +491,18 @@ void shell::leave_node(char_iter first, char_iter last) {
   }
   m_cli.mode_pop();
   cout << "Leaving node-mode" << endl;
-  m_engine->unset("NODE");
+  if (!m_node_stack.empty()) {
+    m_node_stack.pop_back();
+  }
+  if (m_node_stack.empty()) {
+    m_engine->unset("NODE");
+    anon_send(m_indexer, atom("SetNode"), invalid_node_id);
+  } else {
+    // back to the node we came from
+    m_node = m_node_stack.back();
+    m_engine->set("NODE", to_string(m_node));
+    anon_send(m_indexer, atom("SetNode"), m_node);
+  }
 }
 
 void shell::work_load(char_iter first, char_iter last) {
@@ -401,6 +617,13 @@ void shell::interfaces(char_iter first, char_iter last) {
 }
 
 void shell::send(char_iter first, char_iter last) {
+  const std::string profile_flag = "--profile ";
+  bool profile = static_cast<size_t>(std::distance(first, last))
+                   > profile_flag.size()
+                 && std::equal(profile_flag.begin(), profile_flag.end(), first);
+  if (profile) {
+    first += static_cast<ptrdiff_t>(profile_flag.size());
+  }
   const char* cfirst = &(*first);
   const char* clast = &(*last);
   char* pos;
@@ -420,6 +643,9 @@ void shell::send(char_iter first, char_iter last) {
     return;
   }
   auto m = *msg;
+  if (profile) {
+    print_profile(m);
+  }
   m_self->sync_send(m_nexus_proxy, atom("GetActor"), m_node, aid).await(
     [&](const actor& handle) {
       if (handle == invalid_actor) {
@@ -431,6 +657,99 @@ void shell::send(char_iter first, char_iter last) {
   );
 }
 
+void shell::profile_msg(char_iter first, char_iter last) {
+  if (first == last) {
+    set_error("usage: profile-msg <message>");
+    return;
+  }
+  auto msg = from_string<message>(std::string(first, last));
+  if (!msg) {
+    set_error("cannot deserialize a message from given input");
+    return;
+  }
+  print_profile(*msg);
+}
+
+void shell::traceroute(char_iter first, char_iter last) {
+  using clock_type = std::chrono::steady_clock;
+  using ms = std::chrono::duration<double, std::milli>;
+  auto args = split_args(first, last);
+  if (args.empty() || args.size() > 2) {
+    set_error("usage: traceroute <node> [repeats]");
+    return;
+  }
+  size_t repeats = 3;
+  if (args.size() == 2) {
+    try {
+      repeats = std::stoul(args[1]);
+    } catch (...) {
+      repeats = 0;
+    }
+    if (repeats == 0) {
+      set_error("traceroute: invalid number of repeats");
+      return;
+    }
+  }
+  auto dest = from_string<node_id>(args[0]);
+  if (!dest) {
+    dest = from_hostname(args[0]);
+  }
+  if (!dest) {
+    set_error("traceroute: invalid host format or ambiguous or not known host");
+    return;
+  }
+  // probes leave through our own middleman, so the path starts here
+  auto path = route_to(m_self->node(), *dest);
+  if (path.empty()) {
+    set_error("traceroute: no route to " + args[0]);
+    return;
+  }
+  // each time is a full round trip from this shell to the hop, i.e.,
+  // it includes all hops before it
+  cout << "traceroute to " << args[0] << ", " << (path.size() - 1) << " hops"
+       << endl;
+  for (size_t i = 1; i < path.size(); ++i) {
+    auto host = to_hostname(path[i]);
+    cout << setw(3) << i << "  "
+         << setw(30) << left << (host ? *host : to_string(path[i])) << right
+         << flush;
+    std::vector<double> rtts;
+    for (size_t j = 0; j < repeats; ++j) {
+      // look up the proxy for each probe, since the remote node
+      // tells us to kill it after failing to find its actor
+      auto target = bounce_target(path[i]);
+      if (target == invalid_actor) {
+        continue;
+      }
+      auto start = clock_type::now();
+      m_self->sync_send(target, atom("Ping")).await(
+        [&](const sync_exited_msg&) {
+          rtts.push_back(ms(clock_type::now() - start).count());
+        },
+        others() >> [] {
+          // not a bounce, count as lost
+        },
+        after(traceroute_timeout) >> [] {
+          // nop
+        }
+      );
+    }
+    if (rtts.empty()) {
+      cout << std::string(repeats, '*') << endl;
+      continue;
+    }
+    auto mm = std::minmax_element(rtts.begin(), rtts.end());
+    auto avg = std::accumulate(rtts.begin(), rtts.end(), 0.) / rtts.size();
+    cout << "min/avg/max = " << format_fixed(*mm.first, 3)
+         << "/" << format_fixed(avg, 3)
+         << "/" << format_fixed(*mm.second, 3) << " ms";
+    if (rtts.size() < repeats) {
+      cout << " (" << (repeats - rtts.size()) << " lost)";
+    }
+    cout << endl;
+  }
+}
+
 void shell::mailbox(char_iter first, char_iter last) {
   // TODO: implement me
   set_error("mailbox: not implemented yet");
@@ -442,7 +761,7 @@ void shell::dequeue(char_iter first, char_iter last) {
 }
 
 void shell::pop_front(char_iter first, char_iter last) {
-  if (!assert_empty(first, last)) {
+  if (!assert_empty(first, last) || !assert_not_capturing("pop-front")) {
     return;
   }
   m_user->receive(
@@ -456,7 +775,7 @@ void shell::pop_front(char_iter first, char_iter last) {
 }
 
 void shell::await_msg(char_iter first, char_iter last) {
-  if (!assert_empty(first, last)) {
+  if (!assert_empty(first, last) || !assert_not_capturing("await-msg")) {
     return;
   }
   m_user->receive(
@@ -466,6 +785,325 @@ void shell::await_msg(char_iter first, char_iter last) {
   );
 }
 
+void shell::capture(char_iter first, char_iter last) {
+  auto args = split_args(first, last);
+  auto usage = "usage: capture start [samples/s] [file] | stop | stats | show";
+  if (args.empty()) {
+    set_error(usage);
+    return;
+  }
+  auto& cmd = args.front();
+  if (cmd == "start") {
+    if (m_capture) {
+      set_error("capture: already running");
+      return;
+    }
+    size_t samples = 10;
+    if (args.size() > 1) {
+      try {
+        samples = std::stoul(args[1]);
+      } catch (...) {
+        set_error("capture: invalid number of samples per second");
+        return;
+      }
+    }
+    std::string file = args.size() > 2 ? args[2] : std::string{};
+    if (args.size() > 3) {
+      set_error(usage);
+      return;
+    }
+    m_capture.reset(new capture_sink(m_user, samples, file));
+    if (!m_capture->good()) {
+      m_capture.reset();
+      set_error("capture: cannot open " + file);
+    }
+    return;
+  }
+  if (!m_capture) {
+    set_error("capture: not running");
+    return;
+  }
+  if (args.size() > 1) {
+    set_error(usage);
+  } else if (cmd == "stop") {
+    m_capture.reset();
+  } else if (cmd == "show") {
+    for (auto& sample : m_capture->take_samples()) {
+      cout << sample << endl;
+    }
+  } else if (cmd == "stats") {
+    auto totals = m_capture->totals();
+    cout << setw(40) << left << "Type" << right
+         << setw(12) << "Count"
+         << setw(12) << "Msgs/s"
+         << setw(14) << "Bytes"
+         << setw(10) << "Avg"
+         << endl;
+    for (auto& kvp : m_capture->stats()) {
+      auto& st = kvp.second;
+      cout << setw(40) << left << kvp.first << right
+           << setw(12) << st.count
+           << setw(12) << static_cast<uint64_t>(st.last_rate + 0.5)
+           << setw(14) << st.bytes
+           << setw(10);
+      // messages without a wire size do not count towards the average
+      auto sized = st.count - st.unsized;
+      if (sized > 0) {
+        cout << (st.bytes / sized);
+      } else {
+        cout << "-";
+      }
+      cout << endl;
+    }
+    cout << totals.first << " messages in "
+         << format_fixed(totals.second, 1) << "s" << endl;
+  } else {
+    set_error(usage);
+  }
+}
+
+void shell::find_addr(char_iter first, char_iter last) {
+  std::string input(first, last);
+  address_key key;
+  if (input.empty() || !parse_address(input, key)) {
+    set_error("usage: find-addr <ip|mac|cidr>");
+    return;
+  }
+  if (m_address_refresher == invalid_actor) {
+    // only keep the address book up to date once it is used
+    m_address_book = std::make_shared<address_book>();
+    m_address_refresher = spawn_address_book(m_nexus_proxy, m_address_book);
+  }
+  // hold on to the snapshot while printing its entries
+  auto addrs = m_address_book->addresses();
+  for (int i = 0; !addrs && i < 100; ++i) {
+    // wait for the first index after starting the refresher
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    addrs = m_address_book->addresses();
+  }
+  if (!addrs) {
+    set_error("find-addr: address book not ready yet, try again");
+    return;
+  }
+  std::vector<const address_index::entry*> matches;
+  addrs->find(key, matches);
+  if (matches.empty()) {
+    cout << "find-addr: no node owns " << input << endl;
+    return;
+  }
+  for (auto e : matches) {
+    cout << setw(40) << left << e->address
+         << setw(10) << e->interface
+         << e->hostname << ":" << e->node.process_id()
+         << right << endl;
+  }
+}
+
+void shell::proxy_growth(char_iter first, char_iter last) {
+  auto args = split_args(first, last);
+  auto usage = "usage: proxy-growth start [interval-ms] | stop | [all]";
+  if (args.size() > 2) {
+    set_error(usage);
+    return;
+  }
+  if (!args.empty() && args.front() == "start") {
+    if (m_proxy_sampler != invalid_actor) {
+      set_error("proxy-growth: already running");
+      return;
+    }
+    long interval = 10000;
+    if (args.size() == 2) {
+      try {
+        interval = std::stol(args[1]);
+      } catch (...) {
+        interval = 0;
+      }
+      if (interval <= 0) {
+        set_error("proxy-growth: invalid interval");
+        return;
+      }
+    }
+    m_proxy_tracker = std::make_shared<proxy_tracker>();
+    m_proxy_sampler = spawn_proxy_tracker(m_nexus_proxy, m_proxy_tracker,
+                                          std::chrono::milliseconds(interval));
+    return;
+  }
+  if (args.size() > 1) {
+    set_error(usage);
+    return;
+  }
+  if (!args.empty() && args.front() == "stop") {
+    if (m_proxy_sampler == invalid_actor) {
+      set_error("proxy-growth: not running");
+      return;
+    }
+    anon_send_exit(m_proxy_sampler, exit_reason::user_shutdown);
+    m_proxy_sampler = invalid_actor;
+    return;
+  }
+  bool all = !args.empty() && args.front() == "all";
+  if (!args.empty() && !all) {
+    set_error(usage);
+    return;
+  }
+  if (!m_proxy_tracker) {
+    set_error("proxy-growth: not started, run 'proxy-growth start' first");
+    return;
+  }
+  auto trends = m_proxy_tracker->trends();
+  // show the fastest growing nodes first
+  std::sort(trends.begin(), trends.end(),
+            [](const proxy_tracker::trend& x, const proxy_tracker::trend& y) {
+    return x.slope > y.slope;
+  });
+  cout << setw(30) << left << "Node" << right
+       << setw(10) << "Proxies"
+       << setw(10) << "Growth"
+       << setw(12) << "Per min"
+       << setw(10) << "Rising"
+       << setw(10) << "Falling"
+       << setw(9)  << "Samples"
+       << endl;
+  size_t shown = 0;
+  for (auto& t : trends) {
+    if (!all && !t.steady) {
+      continue;
+    }
+    ++shown;
+    auto host = to_hostname(t.node);
+    cout << setw(30) << left << (host ? *host : to_string(t.node)) << right
+         << setw(10) << t.count
+         << setw(10) << t.growth
+         << setw(12) << format_fixed(t.slope, 2)
+         << setw(10) << t.rising
+         << setw(10) << t.falling
+         << setw(9)  << t.samples
+         << (t.steady ? "  steady growth" : "")
+         << endl;
+  }
+  if (shown == 0 && !all) {
+    cout << "proxy-growth: no node with steadily growing proxy count" << endl;
+  }
+  cout << "note: only proxy counts are sampled, churn (created vs. vanished "
+          "actor IDs) is not reported" << endl;
+}
+
+void shell::record(char_iter first, char_iter last) {
+  auto args = split_args(first, last);
+  auto usage = "usage: record start <dir> [interval-ms] | open <dir> | stop";
+  if (args.empty() || args.size() > 3) {
+    set_error(usage);
+    return;
+  }
+  auto& cmd = args.front();
+  if (cmd == "stop") {
+    if (args.size() != 1 || m_recorder == invalid_actor) {
+      set_error(args.size() != 1 ? usage : "record: not running");
+      return;
+    }
+    anon_send_exit(m_recorder, exit_reason::user_shutdown);
+    m_recorder = invalid_actor;
+    m_store->flush();
+    return;
+  }
+  if ((cmd != "start" && cmd != "open") || args.size() < 2
+      || (cmd == "open" && args.size() > 2)) {
+    set_error(usage);
+    return;
+  }
+  if (m_recorder != invalid_actor) {
+    set_error("record: already running, run 'record stop' first");
+    return;
+  }
+  long interval = 10000;
+  if (args.size() == 3) {
+    try {
+      interval = std::stol(args[2]);
+    } catch (...) {
+      interval = 0;
+    }
+    if (interval <= 0) {
+      set_error("record: invalid interval");
+      return;
+    }
+  }
+  // opening a store for queries must not modify it
+  auto store = std::make_shared<metrics_store>(args[1], cmd == "open");
+  if (!store->good()) {
+    set_error("record: cannot open " + args[1]);
+    return;
+  }
+  m_store = store;
+  if (cmd == "start") {
+    m_recorder = spawn_metrics_recorder(m_nexus_proxy, m_store,
+                                        std::chrono::milliseconds(interval));
+  }
+}
+
+void shell::query(char_iter first, char_iter last) {
+  auto args = split_args(first, last);
+  if (args.size() < 4 || args.size() > 5) {
+    set_error("usage: query <node|selector> <metric> <from> <to> [step]");
+    return;
+  }
+  if (!m_store) {
+    set_error("query: no store, run 'record open <dir>' first");
+    return;
+  }
+  auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch()).count();
+  metrics_store::timestamp from;
+  metrics_store::timestamp to;
+  if (!parse_time(args[2], now, from) || !parse_time(args[3], now, to)
+      || from >= to) {
+    set_error("query: invalid time range");
+    return;
+  }
+  // split the range into 60 buckets by default
+  auto step = std::max((to - from) / 60, metrics_store::timestamp{1});
+  if (args.size() == 5 && (!parse_duration(args[4], step) || step <= 0)) {
+    set_error("query: invalid step");
+    return;
+  }
+  auto& sel = args[0];
+  // node IDs as printed by whereami are stored in sanitized form
+  auto nid = from_string<node_id>(sel);
+  auto sel_series = nid ? series_name(*nid) : sel;
+  auto matches = [&](const std::string& series, const std::string& label) {
+    if (sel == "*" || sel == label || sel_series == series
+        || sel == label.substr(0, label.rfind(':'))) {
+      return true;
+    }
+    return sel.size() > 1 && sel.back() == '*'
+           && label.compare(0, sel.size() - 1, sel, 0, sel.size() - 1) == 0;
+  };
+  size_t found = 0;
+  for (auto& s : m_store->series()) {
+    if (!matches(s.first, s.second)) {
+      continue;
+    }
+    ++found;
+    cout << s.second << " " << args[1] << endl
+         << setw(21) << left << "  Time" << right
+         << setw(14) << "Avg"
+         << setw(14) << "Min"
+         << setw(14) << "Max"
+         << setw(10) << "Samples"
+         << endl;
+    for (auto& b : m_store->query(s.first, args[1], from, to, step)) {
+      cout << "  " << format_time(b.start)
+           << setw(14) << format_fixed(b.sum / b.count, 2)
+           << setw(14) << format_fixed(b.min, 2)
+           << setw(14) << format_fixed(b.max, 2)
+           << setw(10) << b.count
+           << endl;
+    }
+  }
+  if (found == 0) {
+    set_error("query: no recorded node matches " + sel);
+  }
+}
+
 void shell::list_actors(char_iter first, char_iter last) {
   if (!assert_empty(first, last)) {
     return;
@@ -497,7 +1135,9 @@ void shell::set_node(const node_id& id) {
   auto node_str = to_string(id);
   m_engine->set("NODE", node_str);
   m_node = id;
+  m_node_stack.push_back(id);
   m_cli.mode_push("node");
+  anon_send(m_indexer, atom("SetNode"), id);
 }
 
 std::string shell::get_routes(const node_id& id) {
@@ -525,6 +1165,62 @@ std::string shell::get_routes(const node_id& id) {
   return accu.str();
 }
 
+std::vector<node_id> shell::route_to(const node_id& src,
+                                     const node_id& dest) {
+  // breadth-first search over the direct routes reported to the nexus
+  std::map<node_id, node_id> parent{{src, src}};
+  std::deque<node_id> pending{src};
+  auto visit = [&](const node_id& current, const node_id& neighbour) {
+    if (parent.emplace(neighbour, current).second) {
+      pending.push_back(neighbour);
+    }
+  };
+  while (!pending.empty() && parent.count(dest) == 0) {
+    auto current = pending.front();
+    pending.pop_front();
+    // the shell is no riac node, its only known route is the nexus node
+    if (current == m_self->node()) {
+      visit(current, m_nexus_node);
+    }
+    m_self->sync_send(m_nexus_proxy, atom("Routes"), current).await(
+      [&](const std::set<node_id>& conn) {
+        for (auto& neighbour : conn) {
+          visit(current, neighbour);
+        }
+      },
+      after(traceroute_timeout) >> [] {
+        // nop
+      }
+    );
+  }
+  std::vector<node_id> result;
+  if (parent.count(dest) == 0) {
+    return result;
+  }
+  for (auto n = dest; n != src; n = parent[n]) {
+    result.push_back(n);
+  }
+  result.push_back(src);
+  std::reverse(result.begin(), result.end());
+  return result;
+}
+
+actor shell::bounce_target(const node_id& node) {
+  // proxies must be created on the middleman's thread
+  auto res = std::make_shared<std::promise<actor>>();
+  auto mm = io::middleman::instance();
+  mm->run_later([node, res, mm] {
+    auto bro = mm->get_named_broker<io::basp_broker>(atom("_BASP"));
+    auto proxy = bro->get_namespace().get_or_put(node, traceroute_actor_id);
+    res->set_value(actor_cast<actor>(proxy));
+  });
+  auto f = res->get_future();
+  if (f.wait_for(traceroute_timeout) != std::future_status::ready) {
+    return invalid_actor;
+  }
+  return f.get();
+}
+
 optional<node_id> shell::from_hostname(const std::string& input) {
   std::vector<std::string> hostname;
   caf::split(hostname, input, ":");
@@ -558,6 +1254,43 @@ optional<node_id> shell::from_hostname(const std::string& input) {
   return ni;
 }
 
+void shell::print_profile(const message& msg) {
+  // actor handles are serialized via the namespace of the BASP broker,
+  // which must only be used from the middleman's thread
+  auto job = std::make_shared<profile_job>(msg);
+  auto res = job->done.get_future();
+  job->schedule();
+  auto p = res.get();
+  if (!p.error.empty()) {
+    cout << "cannot profile message: " << p.error << endl;
+    return;
+  }
+  cout << "wire size: " << p.wire_size << " bytes" << endl
+       << setw(5) << "#"
+       << "  " << setw(30) << left << "Type" << right
+       << setw(10) << "Bytes"
+       << endl;
+  size_t payload = 0;
+  for (size_t i = 0; i < p.elements.size(); ++i) {
+    payload += p.elements[i].second;
+    cout << setw(5) << i
+         << "  " << setw(30) << left << p.elements[i].first << right
+         << setw(10) << p.elements[i].second
+         << endl;
+  }
+  cout << setw(5) << "-"
+       << "  " << setw(30) << left << "type information" << right
+       << setw(10) << (p.wire_size - payload)
+       << endl;
+  for (auto& t : {std::make_pair("encode", &p.encode),
+                  std::make_pair("decode", &p.decode)}) {
+    std::chrono::duration<double, std::micro> avg = t.second->elapsed;
+    cout << t.first << ": "
+         << format_fixed(avg.count() / t.second->iterations, 3)
+         << " us/msg (" << t.second->iterations << " iterations)" << endl;
+  }
+}
+
 optional<std::string> shell::to_hostname(const node_id& node) {
   if (node == invalid_node_id) {
     return none;